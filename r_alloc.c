@@ -6,6 +6,8 @@
 #define MB *1024*1024
 #define ARENA_SIZE 8*1024*1024
 #define MIN_ALLOC_SIZE 32       //Minimum allocation check, used to prevent unnessecary small allocations
+#define BLOCK_ALIGN 16          //Alignment of every pointer handed out, matches max_align_t / default operator new
+#define ALIGN_UP(x) (((x) + BLOCK_ALIGN - 1) & ~((size_t)BLOCK_ALIGN - 1))
 
 //MAP ANONYMOUS will not show as defined
 #define MAP_ANONYMOUS 0x20
@@ -17,6 +19,11 @@
 //Notes: When referring to saving a pointer, this is in reference to the DLL implementation I was originally using
 //meaning the new implemnetation uses one less pointer
 //This is a single threaded implementation
+//r_alloc_init_pool swaps mmap for a caller-supplied buffer, holding the manager and one arena, with no syscalls afterwards
+//Pools are process-local: the manager pointer is a static, blocks link by absolute address and there is no locking,
+//so a pool placed in shared memory can't be attached to or used from a second process
+//Latency is not bounded: r_malloc is first-fit over the arena free lists and r_free unlinks merged neighbours by
+//walking the SLL free list, so both are O(free blocks), a fragmented pool makes both slower
 
 //Memory manager structure, should only be one instance at a time
 //Needs to hold a global free list, for large alocations, (greater than the 8MB arena size)
@@ -25,6 +32,7 @@
 struct __memman {
     struct __memarena* arenas;
     struct __memblck* global_free_list;     //
+    bool pooled;                            //Set when running over a caller-supplied buffer, no syscalls allowed
 };
 
 //Memory arena, large block of free data acquired via mmap
@@ -35,16 +43,21 @@ struct __memman {
 struct __memarena {
     struct __memarena* next_arena;      //Single linked list, saves a pointer and one-way traversal
     void* free_list;                    //Pointer to the first free block
-    uint8_t data[];                     //Start of arena memory
+    size_t size;                        //Size of the data region, ARENA_SIZE unless carved from a pool
+    _Alignas(BLOCK_ALIGN) uint8_t data[]; //Start of arena memory, padded so blocks start BLOCK_ALIGN aligned
 };
 
 //Memory block, subdivided from arena
 struct __memblck {
     size_t size;                        //Size of allocated block
+    size_t prev_size;                   //Size of the physically preceding block, 0 for the first block in an arena
     struct __memblck* next_block;       //Single linked list, saves a pointer
     bool active;                        //Used for freeing
 };
 
+//Block headers sit directly in front of user pointers, so they have to keep BLOCK_ALIGN alignment
+_Static_assert(sizeof(struct __memblck) % BLOCK_ALIGN == 0, "block header must be a multiple of BLOCK_ALIGN");
+
 //Global memory manager, to this file at least
 static bool manager_initialized = false;
 static struct __memman* mem0 = NULL;
@@ -55,13 +68,14 @@ static void* __block_to_ptr(struct __memblck*);
 static struct __memblck* __create_new_allocation(struct __memman*, size_t);
 static struct __memblck* __find_arena_block(struct __memman*, size_t);
 static struct __memblck* __find_global_block(struct __memman*, size_t);
-static void __free_arena_block(struct __memman*, struct __memblck*);
+static void __free_arena_block(struct __memman*, struct __memarena*, struct __memblck*);
 static void __free_global_block(struct __memman*, struct __memblck*);
 static struct __memblck* __ptr_to_block(void*);
 static struct __memarena* __find_container_arena(struct __memman*, struct __memblck*);
-static void __aggregate_arena_blocks(struct __memarena*, struct __memblck*);
+static struct __memblck* __aggregate_arena_blocks(struct __memarena*, struct __memblck*);
 static void __aggregate_global_blocks(struct __memman*, struct __memblck*);
-static struct __memblck* __find_previous_block(struct __memarena*, struct __memblck*);
+static struct __memblck* __find_previous_block(struct __memblck*);
+static void __set_next_prev_size(struct __memarena*, struct __memblck*);
 static void __remove_free_list_entry(struct __memarena*, struct __memblck*);
 static void __remove_arena(struct __memman*, struct __memarena*);
 static struct __memman* get_manager();
@@ -74,6 +88,11 @@ void* r_malloc(size_t size) {
         return NULL;
     }
 
+    //Reject sizes that would wrap around once aligned and given a header (global blocks carry two headers)
+    if (size > SIZE_MAX - 2 * sizeof(struct __memblck) - (BLOCK_ALIGN - 1)) {
+        return NULL;
+    }
+
     //Get access to the memory manager_alloc_s
     struct __memman* mman = get_manager();
 
@@ -82,7 +101,8 @@ void* r_malloc(size_t size) {
     struct __memblck* newblck = NULL;
 
     //If the size is less than 1/16th of an arena, use the arena block, if larger, get a global block
-    if (alloc_size < ARENA_SIZE / 16) {
+    //A pool is a single arena spanning the whole buffer, so every size is served from it
+    if (mman->pooled || alloc_size < ARENA_SIZE / 16) {
         newblck = __find_arena_block(mman, alloc_size);
     }
 
@@ -91,7 +111,8 @@ void* r_malloc(size_t size) {
     }
 
     //If the global/local allocation failed, a new allocation is needed under the respective subtype
-    if (!newblck) {
+    //Pools can't grow, so running out of space is reported straight away
+    if (!newblck && !mman->pooled) {
         newblck = __create_new_allocation(mman, alloc_size);
     }
 
@@ -152,9 +173,11 @@ void r_free(void *ptr) {
 
     struct __memman* mman = get_manager();
 
-    //Call the appropriate freeing function
-    if (block->size <= ARENA_SIZE) {
-        __free_arena_block(mman, block);
+    //Call the appropriate freeing function, based on where the block lives rather than its size
+    //r_malloc splits arena and global blocks at ARENA_SIZE / 16, but an unsplit arena block can end up slightly larger
+    struct __memarena* arena = __find_container_arena(mman, block);
+    if (arena) {
+        __free_arena_block(mman, arena, block);
     }
 
     else {
@@ -196,7 +219,7 @@ bool r_allocated(void *ptr) {
     // Check arenas
     struct __memarena* arena = mman->arenas;
     while (arena) {
-        if ((uint8_t*)blk >= arena->data && (uint8_t*)blk < arena->data + ARENA_SIZE) {
+        if ((uint8_t*)blk >= arena->data && (uint8_t*)blk < arena->data + arena->size) {
             struct __memblck* current = arena->free_list;
 
             //Check if the block is found in the arena free lists
@@ -227,7 +250,7 @@ size_t r_total_allocated(void) {
 
     //Get arena allocations
     while (arena) {
-        uint8_t* arena_end = arena->data + ARENA_SIZE;
+        uint8_t* arena_end = arena->data + arena->size;
         struct __memblck* blk = (struct __memblck*)arena->data;
         while ((uint8_t*)blk < arena_end) {
             //If block is active, accumulate it
@@ -258,32 +281,81 @@ size_t r_total_allocated(void) {
     return total_allocated;
 }
 
+bool r_alloc_init_pool(void *buf, size_t len) {
+    //The pool has to be set up before anything touches the heap (r_malloc, r_allocated, ...), and can't be swapped out afterwards
+    //The buffer is always formatted from scratch, there is no way to attach to an existing pool
+    if (manager_initialized || buf == NULL) {
+        return false;
+    }
+
+    //Align the start of the buffer to BLOCK_ALIGN, same alignment the blocks use
+    uintptr_t start = ALIGN_UP((uintptr_t)buf);
+    uintptr_t end = (uintptr_t)buf + len;
+
+    //Manager goes first, followed by a single arena covering the rest of the buffer
+    size_t overhead = ALIGN_UP(sizeof(struct __memman)) + sizeof(struct __memarena);
+    if (end < start || end - start < overhead + sizeof(struct __memblck) + MIN_ALLOC_SIZE) {
+        return false;
+    }
+
+    //Keep the arena size a multiple of BLOCK_ALIGN, so the last block stays aligned
+    size_t data_size = (end - start - overhead) & ~((size_t)BLOCK_ALIGN - 1);
+
+    struct __memman* mman = (struct __memman*)start;
+    struct __memarena* arena = (struct __memarena*)(start + ALIGN_UP(sizeof(struct __memman)));
+
+    //Set-up the arena metadata, the buffer isn't guaranteed to be zeroed like mmap memory is
+    arena->next_arena = NULL;
+    arena->free_list = (struct __memblck*)(arena->data);
+    arena->size = data_size;
+
+    //Create the initial free block - Size of whole arena, it'll be split later
+    struct __memblck* initial_block = (struct __memblck*)(arena->data);
+    initial_block->size = data_size;
+    initial_block->prev_size = 0;
+    initial_block->next_block = NULL;
+    initial_block->active = false;
+
+    //Set-up the manager, from here on get_manager will never touch the kernel
+    mman->arenas = arena;
+    mman->global_free_list = NULL;
+    mman->pooled = true;
+
+    mem0 = mman;
+    manager_initialized = true;
+    return true;
+}
+
 //  Helper function implementations
 
-//Helper function to align size to system's size_t and include metadata
+//Helper function to align size to BLOCK_ALIGN and include metadata
 size_t __alloc_size(size_t size) {
-    size_t aligned_size = (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    size_t aligned_size = ALIGN_UP(size);
     return sizeof(struct __memblck) + aligned_size;
 }
 
 //Use bidirectional coalescing for the arena memory blocks
-static void __aggregate_arena_blocks(struct __memarena* arena, struct __memblck* blk) {
+//Returns the merged block, which is already on the free list if it absorbed the previous block
+static struct __memblck* __aggregate_arena_blocks(struct __memarena* arena, struct __memblck* blk) {
     // Forward coalesce (check next block)
     struct __memblck* next = (struct __memblck*)((char*)blk + blk->size);
     //
-    if ((char*)next < arena->data + ARENA_SIZE && !next->active) {
+    if ((uint8_t*)next < arena->data + arena->size && !next->active) {
         blk->size += next->size;
         __remove_free_list_entry(arena, next);
     }
 
     //Backward coalesce (check previous block)
-    struct __memblck* prev = __find_previous_block(arena, blk);
+    struct __memblck* prev = __find_previous_block(blk);
     //
-    if (prev && !prev->active && (char*)prev + prev->size == (char*)blk) {
+    if (prev && !prev->active) {
         prev->size += blk->size;
-        __remove_free_list_entry(arena, blk);
         blk = prev;
     }
+
+    //Whatever follows the merged block needs to know its new predecessor size
+    __set_next_prev_size(arena, blk);
+    return blk;
 }
 
 //Helper function to group large blocks
@@ -348,11 +420,14 @@ static struct __memblck* __create_new_allocation(struct __memman* mman, size_t a
         //Set-up the arena metadata
         new_arena->next_arena = mman->arenas;
         new_arena->free_list = (struct __memblck*)(new_arena->data);
+        new_arena->size = ARENA_SIZE;
 
         //Create the initial free block - Size of whole arena, it'll be split later
         struct __memblck* initial_block = (struct __memblck*)(new_arena->data);
         initial_block->size = ARENA_SIZE;
+        initial_block->prev_size = 0;
         initial_block->next_block = NULL;
+        initial_block->active = false;
 
         //Update head of arena SLL
         mman->arenas = new_arena;
@@ -374,6 +449,7 @@ static struct __memblck* __create_new_allocation(struct __memman* mman, size_t a
         //Since allocation passed, initialize block metadata
         struct __memblck* global_block = (struct __memblck*) mem_addr;
         global_block->size = total_size;
+        global_block->prev_size = 0;
         global_block->active = true;
 
         return global_block;
@@ -405,9 +481,14 @@ static struct __memblck* __find_arena_block(struct __memman* mman, size_t alloc_
                 if (space_remaining >= sizeof(struct __memblck) + MIN_ALLOC_SIZE) {
                     struct __memblck* split = (struct __memblck*)((char*)current + alloc_size);
                     split->size = space_remaining;
+                    split->prev_size = alloc_size;
+                    split->active = false;
                     split->next_block = p_arenas->free_list;
                     p_arenas->free_list = split;
                     current->size = alloc_size;
+
+                    //The block after the split now sits behind the split, not the original block
+                    __set_next_prev_size(p_arenas, split);
                 };
 
                 return current;
@@ -433,10 +514,10 @@ static struct __memarena* __find_container_arena(struct __memman* mman, struct _
 
     //While the pointer is valid...
     while (p_arenas) {
-        char* p_memblck = ((char*)memblck);
+        uint8_t* p_memblck = ((uint8_t*)memblck);
 
-        //Check if block is contained within the arenas data space (>= start, < end), needs to be casted to char
-        if (p_arenas->data <= p_memblck && p_arenas->data + ARENA_SIZE > p_memblck) {
+        //Check if block is contained within the arenas data space (>= start, < end), needs to be casted to uint8_t
+        if (p_arenas->data <= p_memblck && p_arenas->data + p_arenas->size > p_memblck) {
             return p_arenas;
         }
 
@@ -464,6 +545,8 @@ static struct __memblck* __find_global_block(struct __memman* mman, size_t alloc
             if (space_remaining >= sizeof(struct __memblck) + MIN_ALLOC_SIZE) {
                 struct __memblck* split = (struct __memblck*)((char*)current + alloc_size);
                 split->size = space_remaining;
+                split->prev_size = alloc_size;
+                split->active = false;
                 split->next_block = mman->global_free_list;
                 mman->global_free_list = split;
                 current->size = alloc_size;
@@ -482,47 +565,46 @@ static struct __memblck* __find_global_block(struct __memman* mman, size_t alloc
     return NULL;
 }
 
-//Helper function to find the previous block
-static struct __memblck* __find_previous_block(struct __memarena* arena, struct __memblck* blk) {
-    //Starting from the head of the free list
-    struct __memblck* blk_head = arena->free_list;
-
-    //While the list is able to be traversed (blk_head != NULL)
-    while (blk_head) {
-        //If the pointer to the next block is equal to the argument pointer block, i've found it
-        if (blk_head->next_block == blk) {
-            return blk_head;
-        }
-        //Else continue traversal
-        blk_head = blk_head->next_block;
+//Helper function to find the block physically preceding blk in the arena
+//Each header records its predecessor's size (boundary tag), so this lookup is O(1) instead of walking the arena
+//Only the lookup though: unlinking a merged block from the SLL free list is still O(free blocks)
+static struct __memblck* __find_previous_block(struct __memblck* blk) {
+    //The first block in the arena has no predecessor
+    if (blk->prev_size == 0) {
+        return NULL;
     }
 
-    return NULL;
+    return (struct __memblck*)((uint8_t*)blk - blk->prev_size);
 }
 
-//Helper function to free an arenas block
-static void __free_arena_block(struct __memman* mman, struct __memblck* blk) {
-    //Find containing arena
-    struct __memarena* arena = __find_container_arena(mman, blk);
-    if (!arena) {
-        //FATAL ERROR
+//Helper function to keep the boundary tag of the block following blk up to date
+static void __set_next_prev_size(struct __memarena* arena, struct __memblck* blk) {
+    struct __memblck* next = (struct __memblck*)((uint8_t*)blk + blk->size);
 
-        return;
+    //The last block in the arena has no successor
+    if ((uint8_t*)next < arena->data + arena->size) {
+        next->prev_size = blk->size;
     }
+}
 
+//Helper function to free an arenas block
+static void __free_arena_block(struct __memman* mman, struct __memarena* arena, struct __memblck* blk) {
     //Aggregate with adjacent free blocks
-    __aggregate_arena_blocks(arena, blk);
-
-    //Add to arena's free list
-    blk->next_block = arena->free_list;
-    arena->free_list = blk;
+    struct __memblck* merged = __aggregate_arena_blocks(arena, blk);
     blk->active = false;
 
+    //Add to arena's free list, unless it was merged into a block that is already on it
+    if (merged == blk) {
+        blk->next_block = arena->free_list;
+        arena->free_list = blk;
+    }
+
     // Check if entire arena is free, if so, free it with the kernel
     //Need the cast here, if not for code to compile, at least to remove errors
+    //Pool arenas belong to the caller, so they are kept around even when empty
     struct __memblck* mb = (struct __memblck*) arena->free_list;
 
-    if (mb->size == ARENA_SIZE) {
+    if (!mman->pooled && mb->size == arena->size) {
         __remove_arena(mman, arena);
     }
 }
@@ -568,6 +650,7 @@ static struct __memman* get_manager() {
         mem0 = mmap(NULL, sizeof(struct __memman), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
         mem0->arenas = NULL;
         mem0->global_free_list = NULL;
+        mem0->pooled = false;
         manager_initialized = true;
     }
 
@@ -601,6 +684,6 @@ void __remove_arena(struct __memman* mman, struct __memarena* arena) {
     }
 
     //Free memory of the arena, and free the size of the metadata + data.
-    munmap(arena, sizeof(struct __memarena) + ARENA_SIZE);
+    munmap(arena, sizeof(struct __memarena) + arena->size);
 }
 
@@ -15,6 +15,7 @@ void	r_free(void *ptr);
 size_t	r_alloc_size(void *ptr);
 bool	r_allocated(void *ptr);
 size_t	r_total_allocated(void);
+bool	r_alloc_init_pool(void *buf, size_t len);
 
 __END_DECLS
 
@@ -0,0 +1,262 @@
+//Include guard
+#ifndef __R_ALLOC_HPP__
+#define __R_ALLOC_HPP__
+
+//Header file include
+#include "r_alloc.h"
+
+//Standard library includes
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+//Notes: Everything here is a thin wrapper over r_alloc.h, so it inherits its single threaded nature
+//r_malloc guarantees 16 byte alignment (block headers and sizes are kept multiples of 16)
+//Anything stricter is handled by over-allocating and stashing the original pointer in front of the aligned one
+//Sized deallocation (allocator::deallocate, memory_resource::do_deallocate, sized delete) is accepted but brings no
+//gain over r_free: the block header already stores the size, and r_free still has to search for the containing arena
+
+namespace ralloc {
+
+//Alignment r_malloc guarantees without any extra work
+inline constexpr std::size_t natural_alignment = 16;
+
+//Alignment the plain operator new must provide, the compiler only uses the align_val_t overloads above this
+//Normally equal to natural_alignment, so plain new goes straight to r_malloc
+inline constexpr std::size_t default_new_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+namespace detail {
+
+//Helper function to allocate size bytes aligned to alignment, returns NULL on failure like r_malloc
+inline void* allocate(std::size_t size, std::size_t alignment) noexcept {
+    //r_malloc returns NULL for 0 byte requests, C++ needs a unique pointer regardless
+    if (size == 0) {
+        size = 1;
+    }
+
+    //Fast path, r_malloc already satisfies the alignment
+    if (alignment <= natural_alignment) {
+        return r_malloc(size);
+    }
+
+    //Over-aligned path, need room to slide the pointer forward and to store the original pointer
+    if (size > std::numeric_limits<std::size_t>::max() - alignment) {
+        return nullptr;
+    }
+
+    void* raw = r_malloc(size + alignment);
+    if (raw == nullptr) {
+        return nullptr;
+    }
+
+    //Since raw is at least natural_alignment aligned, the aligned pointer is at most alignment bytes forward
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    addr = (addr + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+
+    //Save the original pointer directly in front of the aligned one, for freeing
+    void** aligned = reinterpret_cast<void**>(addr);
+    aligned[-1] = raw;
+    return aligned;
+}
+
+//Helper function to recover the pointer r_malloc originally returned
+inline void* base_pointer(void* ptr, std::size_t alignment) noexcept {
+    if (alignment <= natural_alignment) {
+        return ptr;
+    }
+
+    return static_cast<void**>(ptr)[-1];
+}
+
+//Helper function to free a pointer from allocate, size is the size that was requested (0 if unknown)
+inline void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept {
+    //If pointer is already NULL, do nothing
+    if (ptr == nullptr) {
+        return;
+    }
+
+    void* raw = base_pointer(ptr, alignment);
+
+    //The size is only checked against the block header in debug builds, r_free does the same work either way
+    assert(size == 0 || r_alloc_size(raw) >= size);
+    (void)size;
+
+    r_free(raw);
+}
+
+}
+
+//STL allocator adaptor, stateless so any two instances are interchangeable
+template <typename T>
+class allocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    allocator() noexcept = default;
+
+    template <typename U>
+    allocator(const allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        //Guard against the multiplication wrapping around
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+
+        void* ptr = detail::allocate(n * sizeof(T), alignof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        detail::deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const allocator<T>&, const allocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+    return false;
+}
+
+//Polymorphic memory resource backed by r_malloc, usable with the std::pmr containers
+class memory_resource : public std::pmr::memory_resource {
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* ptr = detail::allocate(bytes, alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        detail::deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        //There is only one r_alloc heap, so every instance can free memory from any other
+        return dynamic_cast<const memory_resource*>(&other) != nullptr;
+    }
+};
+
+//Shared instance, for use with std::pmr::polymorphic_allocator and friends
+inline memory_resource* get_memory_resource() noexcept {
+    static memory_resource resource;
+    return &resource;
+}
+
+}
+
+//Optional replacement of the global operator new/delete family
+//Define RALLOC_OVERRIDE_NEW before including this header in exactly ONE translation unit
+//Not compatible with r_alloc_init_pool: operator new runs during static initialization, before main could set up
+//the pool, and once anything has touched the heap r_alloc_init_pool returns false
+#ifdef RALLOC_OVERRIDE_NEW
+
+void* operator new(std::size_t size) {
+    void* ptr = ralloc::detail::allocate(size, ralloc::default_new_alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return ralloc::detail::allocate(size, ralloc::default_new_alignment);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ralloc::detail::allocate(size, ralloc::default_new_alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = ralloc::detail::allocate(size, static_cast<std::size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return ralloc::detail::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return ralloc::detail::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    ralloc::detail::deallocate(ptr, 0, ralloc::default_new_alignment);
+}
+
+void operator delete[](void* ptr) noexcept {
+    ralloc::detail::deallocate(ptr, 0, ralloc::default_new_alignment);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    ralloc::detail::deallocate(ptr, 0, ralloc::default_new_alignment);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    ralloc::detail::deallocate(ptr, 0, ralloc::default_new_alignment);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    ralloc::detail::deallocate(ptr, size, ralloc::default_new_alignment);
+}
+
+void operator delete[](void* ptr, std::size_t size) noexcept {
+    ralloc::detail::deallocate(ptr, size, ralloc::default_new_alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+    ralloc::detail::deallocate(ptr, 0, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+    ralloc::detail::deallocate(ptr, 0, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    ralloc::detail::deallocate(ptr, 0, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    ralloc::detail::deallocate(ptr, 0, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    ralloc::detail::deallocate(ptr, size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    ralloc::detail::deallocate(ptr, size, static_cast<std::size_t>(alignment));
+}
+
+#endif
+
+#endif
@@ -1,8 +1,10 @@
 #define _POSIX_C_SOURCE 200809L
 
 //Standard library includes
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "r_alloc.h"
 
@@ -10,6 +12,12 @@
 #define NUM_TESTS 10
 #define NUM_ITERATIONS 10000
 
+//Pool information, used when run with the "pool" argument
+#define POOL_SIZE 1024*1024
+#define POOL_BLOCK_SIZE 256
+
+static unsigned char pool[POOL_SIZE];
+
 //Sizes to use for testing
 size_t test_sizes[NUM_TESTS] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192};
 
@@ -35,16 +43,83 @@ void benchmark(void* (*alloc_func)(size_t), void (*free_func)(void*), double *re
     }
 }
 
+//Pool scenario, checks that running out of pool space fails cleanly and that freeing everything coalesces it back
+//Returns 0 on success, must run before anything else touches the heap
+int pool_scenario(void) {
+    static void* ptrs[POOL_SIZE / POOL_BLOCK_SIZE];
+    size_t count = 0;
+
+    if (!r_alloc_init_pool(pool, sizeof(pool))) {
+        printf("pool: init failed\n");
+        return 1;
+    }
+
+    //A second init can't replace the pool that's in use
+    if (r_alloc_init_pool(pool, sizeof(pool))) {
+        printf("pool: second init succeeded\n");
+        return 1;
+    }
+
+    //Requests larger than the pool, including ones that would wrap around, have to fail
+    if (r_malloc(POOL_SIZE * 2) != NULL || r_malloc(SIZE_MAX - 3) != NULL) {
+        printf("pool: oversized request did not return NULL\n");
+        return 1;
+    }
+
+    //Fill the pool until it runs out, every pointer has to come from inside the buffer
+    while ((ptrs[count] = r_malloc(POOL_BLOCK_SIZE)) != NULL) {
+        if ((unsigned char*)ptrs[count] < pool || (unsigned char*)ptrs[count] >= pool + sizeof(pool)) {
+            printf("pool: allocation outside of buffer\n");
+            return 1;
+        }
+        count++;
+    }
+
+    //Free every other block first, so both forward and backward coalescing are needed
+    for (size_t i = 0; i < count; i += 2) {
+        r_free(ptrs[i]);
+    }
+    for (size_t i = 1; i < count; i += 2) {
+        r_free(ptrs[i]);
+    }
+
+    if (r_total_allocated() != 0) {
+        printf("pool: %zu bytes still allocated\n", r_total_allocated());
+        return 1;
+    }
+
+    //If everything coalesced back, almost the whole pool can be handed out in one go
+    void* big = r_malloc(POOL_SIZE - 1024);
+    if (big == NULL) {
+        printf("pool: free space did not coalesce\n");
+        return 1;
+    }
+    r_free(big);
+
+    printf("pool: %zu blocks before OOM, coalesced back to a single block\n", count);
+    return 0;
+}
+
 //Main function
-int main() {
+//Run with "pool" to serve r_malloc from a static buffer instead of mmap
+int main(int argc, char** argv) {
     double r_times[NUM_TESTS], libc_times[NUM_TESTS];
+    const char* results_file = "results.csv";
+
+    //Pool mode has to be set up before the benchmark touches the heap
+    if (argc > 1 && strcmp(argv[1], "pool") == 0) {
+        if (pool_scenario() != 0) {
+            return 1;
+        }
+        results_file = "results_pool.csv";
+    }
 
     //Benchmark both alloc and free functions
     benchmark(r_malloc, r_free, r_times);
     benchmark(malloc, free, libc_times);
     
     //Write the results to a file
-    FILE *fp = fopen("results.csv", "w");
+    FILE *fp = fopen(results_file, "w");
     fprintf(fp, "Size,r_malloc,malloc\n");
 
     //Write row to file
@@ -0,0 +1,147 @@
+//Standard library includes
+#include <cstdio>
+#include <ctime>
+#include <list>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include "r_alloc.hpp"
+
+//Test information
+#define NUM_TESTS 4
+#define NUM_ITERATIONS 10000
+#define NUM_WARMUP 100
+#define NUM_ALLOCATORS 3
+
+//Element counts to use for testing
+size_t test_sizes[NUM_TESTS] = {16, 64, 256, 1024};
+
+//Extra vector size whose buffer grows past ARENA_SIZE / 16 (512 KiB), so r_alloc's global blocks are used too
+#define LARGE_VECTOR_SIZE 131072
+
+//Helper to get the current process CPU time in seconds
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//Workloads, each builds the container from scratch so every iteration hits the allocator
+//Templated on a factory so the same loop runs for std::allocator, ralloc::allocator and std::pmr
+template <typename Make>
+double vector_workload(Make make, size_t count, int iterations) {
+    double start = now();
+    for (int j = 0; j < iterations; j++) {
+        auto vec = make();
+        for (size_t k = 0; k < count; k++) {
+            vec.push_back(k);
+        }
+    }
+    return now() - start;
+}
+
+template <typename Make>
+double map_workload(Make make, size_t count, int iterations) {
+    double start = now();
+    for (int j = 0; j < iterations; j++) {
+        auto map = make();
+        for (size_t k = 0; k < count; k++) {
+            map.emplace(k, k);
+        }
+        //Erase half the keys so node frees are interleaved with the final teardown
+        for (size_t k = 0; k < count; k += 2) {
+            map.erase(k);
+        }
+    }
+    return now() - start;
+}
+
+template <typename Make>
+double list_workload(Make make, size_t count, int iterations) {
+    double start = now();
+    for (int j = 0; j < iterations; j++) {
+        auto list = make();
+        for (size_t k = 0; k < count; k++) {
+            list.push_back(k);
+        }
+        //Pop from the front while pushing to the back, to churn the node allocations
+        for (size_t k = 0; k < count; k++) {
+            list.pop_front();
+            list.push_back(k);
+        }
+    }
+    return now() - start;
+}
+
+//Type aliases for each allocator under test
+template <typename T> using r_vector = std::vector<T, ralloc::allocator<T>>;
+template <typename K, typename V> using r_map = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, ralloc::allocator<std::pair<const K, V>>>;
+template <typename T> using r_list = std::list<T, ralloc::allocator<T>>;
+
+//Helper to time one workload under all three allocators, rotating which one goes first
+//Run is called with the allocator index (0 = std, 1 = ralloc, 2 = pmr_ralloc) and the iteration count
+template <typename Run>
+void measure(Run run, int rotate, double* results) {
+    //Untimed warm-up pass, so the first allocator measured doesn't pay for first-touch page faults
+    for (int k = 0; k < NUM_ALLOCATORS; k++) {
+        run(k, NUM_WARMUP);
+    }
+
+    //Timed pass, starting from a different allocator each row
+    for (int k = 0; k < NUM_ALLOCATORS; k++) {
+        int idx = (k + rotate) % NUM_ALLOCATORS;
+        results[idx] = run(idx, NUM_ITERATIONS);
+    }
+}
+
+//Main function
+int main() {
+    double results[NUM_ALLOCATORS];
+
+    //Write the results to a file
+    FILE *fp = fopen("results_cpp.csv", "w");
+    fprintf(fp, "Workload,Size,std,ralloc,pmr_ralloc\n");
+
+    std::pmr::memory_resource* res = ralloc::get_memory_resource();
+
+    //Benchmark each workload under all three allocators and write a row per size
+    for (int i = 0; i <= NUM_TESTS; i++) {
+        size_t n = i < NUM_TESTS ? test_sizes[i] : LARGE_VECTOR_SIZE;
+        measure([res, n](int idx, int iterations) {
+            switch (idx) {
+                case 0: return vector_workload([] { return std::vector<size_t>(); }, n, iterations);
+                case 1: return vector_workload([] { return r_vector<size_t>(); }, n, iterations);
+                default: return vector_workload([res] { return std::pmr::vector<size_t>(res); }, n, iterations);
+            }
+        }, i, results);
+        fprintf(fp, "vector,%zu,%f,%f,%f\n", n, results[0], results[1], results[2]);
+    }
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        size_t n = test_sizes[i];
+        measure([res, n](int idx, int iterations) {
+            switch (idx) {
+                case 0: return map_workload([] { return std::unordered_map<size_t, size_t>(); }, n, iterations);
+                case 1: return map_workload([] { return r_map<size_t, size_t>(); }, n, iterations);
+                default: return map_workload([res] { return std::pmr::unordered_map<size_t, size_t>(res); }, n, iterations);
+            }
+        }, i, results);
+        fprintf(fp, "unordered_map,%zu,%f,%f,%f\n", n, results[0], results[1], results[2]);
+    }
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        size_t n = test_sizes[i];
+        measure([res, n](int idx, int iterations) {
+            switch (idx) {
+                case 0: return list_workload([] { return std::list<size_t>(); }, n, iterations);
+                case 1: return list_workload([] { return r_list<size_t>(); }, n, iterations);
+                default: return list_workload([res] { return std::pmr::list<size_t>(res); }, n, iterations);
+            }
+        }, i, results);
+        fprintf(fp, "list,%zu,%f,%f,%f\n", n, results[0], results[1], results[2]);
+    }
+
+    //Close the file pointer and return 0 to caller
+    fclose(fp);
+    return 0;
+}
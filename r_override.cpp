@@ -0,0 +1,120 @@
+//Replace the global operator new/delete family in this translation unit
+#define RALLOC_OVERRIDE_NEW
+
+//Standard library includes
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "r_alloc.hpp"
+
+//Test information
+#define NUM_ITERATIONS 1000
+#define NUM_ELEMENTS 256
+#define NUM_ALIGNED 5
+
+//Over-aligned type, forces the align_val_t overloads
+struct alignas(64) aligned_block {
+    unsigned char bytes[100];
+};
+
+//Helper to check a pointer is aligned to alignment
+static bool is_aligned(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+//Default allocator containers, every allocation should now come from r_alloc
+int container_scenario() {
+    for (int j = 0; j < NUM_ITERATIONS; j++) {
+        std::vector<std::string> vec;
+        std::unordered_map<std::size_t, std::string> map;
+
+        for (std::size_t k = 0; k < NUM_ELEMENTS; k++) {
+            vec.emplace_back(64, 'x');
+            map.emplace(k, vec.back());
+        }
+
+        //Buffers handed out by operator new must be r_alloc blocks with default new alignment
+        if (!r_allocated(vec.data()) || !is_aligned(vec.data(), __STDCPP_DEFAULT_NEW_ALIGNMENT__)) {
+            printf("override: vector buffer not served by r_alloc\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//alignas(64) new[]/delete[] and pmr allocations above the default alignment
+int aligned_scenario() {
+    aligned_block* blocks = new aligned_block[NUM_ALIGNED];
+    aligned_block* single = new aligned_block;
+
+    bool ok = is_aligned(blocks, alignof(aligned_block)) && is_aligned(single, alignof(aligned_block));
+
+    delete single;
+    delete[] blocks;
+
+    std::pmr::memory_resource* res = ralloc::get_memory_resource();
+    for (std::size_t alignment = 32; alignment <= 4096; alignment *= 2) {
+        void* ptr = res->allocate(100, alignment);
+        ok = ok && is_aligned(ptr, alignment);
+        res->deallocate(ptr, 100, alignment);
+    }
+
+    if (!ok) {
+        printf("override: over-aligned allocation misaligned\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//Requests too large to represent once a header is added have to fail, not wrap around to a tiny block
+int overflow_scenario() {
+    const std::size_t huge = std::numeric_limits<std::size_t>::max() - 20;
+
+    if (r_malloc(huge) != nullptr) {
+        printf("override: r_malloc accepted an overflowing size\n");
+        return 1;
+    }
+
+    try {
+        ralloc::allocator<char>().allocate(huge);
+        printf("override: allocator accepted an overflowing size\n");
+        return 1;
+    }
+    catch (const std::bad_alloc&) {
+    }
+
+    try {
+        void* ptr = ::operator new(huge);
+        ::operator delete(ptr);
+        printf("override: operator new accepted an overflowing size\n");
+        return 1;
+    }
+    catch (const std::bad_alloc&) {
+    }
+
+    return 0;
+}
+
+//Main function
+int main() {
+    size_t baseline = r_total_allocated();
+
+    if (container_scenario() != 0 || aligned_scenario() != 0 || overflow_scenario() != 0) {
+        return 1;
+    }
+
+    //Everything allocated above has been released again
+    if (r_total_allocated() != baseline) {
+        printf("override: %zu bytes leaked\n", r_total_allocated() - baseline);
+        return 1;
+    }
+
+    printf("override: containers and over-aligned new served by r_alloc\n");
+    return 0;
+}